@@ -1,2 +1,35 @@
-//Lo dejo vacío ya que la funcionalidad de ast.cpp la implemente en otros archivos
+//Casi toda la funcionalidad de ast.cpp la implemente en otros archivos
+#include "ast.h"
+
+// CExp y SetExp son incompletos donde se declaran estos nodos, por eso los destructores van aquí
+SetLiteralExp::~SetLiteralExp(){ for (auto e : elems) liberar(e); }
+CardExp::~CardExp(){ liberar(inner); }
+JaccardExp::~JaccardExp(){ liberar(left); liberar(right); }
+
+// Nodos por borrar. El primer liberar() de la cadena vacía la pila; los destructores que
+// corren mientras tanto solo apilan a sus hijos, así la profundidad de C++ queda en uno.
+namespace {
+struct PorBorrar {
+    std::vector<Exp*> e;
+    std::vector<SetExp*> s;
+    std::vector<CExp*> c;
+    bool vaciando = false;
+};
+thread_local PorBorrar pila;
+
+void vaciar(){
+    if (pila.vaciando) return;
+    pila.vaciando = true;
+    while (!pila.e.empty() || !pila.s.empty() || !pila.c.empty()) {
+        if (!pila.e.empty()) { Exp* x = pila.e.back(); pila.e.pop_back(); delete x; }
+        else if (!pila.s.empty()) { SetExp* x = pila.s.back(); pila.s.pop_back(); delete x; }
+        else { CExp* x = pila.c.back(); pila.c.pop_back(); delete x; }
+    }
+    pila.vaciando = false;
+}
+}
+
+void liberar(Exp* e){ if (e) { pila.e.push_back(e); vaciar(); } }
+void liberar(SetExp* s){ if (s) { pila.s.push_back(s); vaciar(); } }
+void liberar(CExp* c){ if (c) { pila.c.push_back(c); vaciar(); } }
 
@@ -3,17 +3,28 @@
 #include <vector>
 #include <set>
 #include <string>
+#include <memory>
+#include "sketch.h"
 
 struct Value {
-    enum Kind { INT, SET } kind;
+    enum Kind { INT, SET, SKETCH } kind;
     int i = 0;
     std::set<int> s;
+    std::shared_ptr<const Sketch> k; // SKETCH: inmutable, se comparte entre copias
 
     static Value fromInt(int v){ Value x; x.kind=INT; x.i=v; return x; }
     static Value fromSet(std::set<int> v){ Value x; x.kind=SET; x.s=std::move(v); return x; }
+    static Value fromSketch(Sketch v){ Value x; x.kind=SKETCH; x.k=std::make_shared<const Sketch>(std::move(v)); return x; }
 };
 
 struct Visitor; // fwd
+struct Exp; struct SetExp; struct CExp; // fwd
+
+// Borra un subárbol sin recursión: una cadena 1+1+...+1 puede tener millones de niveles.
+// Los destructores de los nodos entregan sus hijos aquí en vez de hacer delete directo.
+void liberar(Exp* e);
+void liberar(SetExp* s);
+void liberar(CExp* c);
 
 // ---- expresiones aritméticas
 enum BinaryOp { PLUS_OP, MINUS_OP, MUL_OP, DIV_OP, POW_OP };
@@ -21,22 +32,29 @@ enum BinaryOp { PLUS_OP, MINUS_OP, MUL_OP, DIV_OP, POW_OP };
 struct Exp { virtual ~Exp(){}; virtual Value accept(Visitor* v)=0; };
 struct NumberExp : Exp { int value; NumberExp(int v):value(v){} Value accept(Visitor* v) override; };
 struct IdExp     : Exp { std::string name; IdExp(std::string n):name(std::move(n)){} Value accept(Visitor* v) override; };
-struct BinaryExp : Exp { Exp* left; Exp* right; BinaryOp op; BinaryExp(Exp*l,Exp*r,BinaryOp o):left(l),right(r),op(o){} Value accept(Visitor* v) override; };
-struct SqrtExp   : Exp { Exp* inner; SqrtExp(Exp* e):inner(e){} Value accept(Visitor* v) override; }; // opcional
+struct BinaryExp : Exp { Exp* left; Exp* right; BinaryOp op; BinaryExp(Exp*l,Exp*r,BinaryOp o):left(l),right(r),op(o){} ~BinaryExp(){ liberar(left); liberar(right); } Value accept(Visitor* v) override; };
+struct SqrtExp   : Exp { Exp* inner; SqrtExp(Exp* e):inner(e){} ~SqrtExp(){ liberar(inner); } Value accept(Visitor* v) override; }; // opcional
+
+// card(S) y jaccard(A,B): exactos sobre SET, estimados sobre SKETCH (jaccard en porcentaje)
+struct CardExp    : Exp { SetExp* inner; CardExp(SetExp* e):inner(e){} ~CardExp(); Value accept(Visitor* v) override; };
+struct JaccardExp : Exp { SetExp* left; SetExp* right; JaccardExp(SetExp*l,SetExp*r):left(l),right(r){} ~JaccardExp(); Value accept(Visitor* v) override; };
 
 // ---- expresiones de conjunto
 enum SetOp { UNION_OP, INTERSECT_OP, DIFF_OP };
 
 struct SetExp { virtual ~SetExp(){}; virtual Value accept(Visitor* v)=0; };
 struct SetIdExp     : SetExp { std::string name; SetIdExp(std::string n):name(std::move(n)){} Value accept(Visitor* v) override; };
-struct SetParenExp  : SetExp { SetExp* inner; SetParenExp(SetExp* i):inner(i){} Value accept(Visitor* v) override; };
-struct SetBinaryExp : SetExp { SetExp* left; SetExp* right; SetOp op; SetBinaryExp(SetExp*l,SetExp*r,SetOp o):left(l),right(r),op(o){} Value accept(Visitor* v) override; };
+struct SetParenExp  : SetExp { SetExp* inner; SetParenExp(SetExp* i):inner(i){} ~SetParenExp(){ liberar(inner); } Value accept(Visitor* v) override; };
+struct SetBinaryExp : SetExp { SetExp* left; SetExp* right; SetOp op; SetBinaryExp(SetExp*l,SetExp*r,SetOp o):left(l),right(r),op(o){} ~SetBinaryExp(){ liberar(left); liberar(right); } Value accept(Visitor* v) override; };
+
+// approx(S [, err]): convierte S en conjunto aproximado con err% de error típico (por defecto 2)
+struct ApproxExp    : SetExp { SetExp* inner; Exp* err; ApproxExp(SetExp* i, Exp* e):inner(i),err(e){} ~ApproxExp(){ liberar(inner); liberar(err); } Value accept(Visitor* v) override; };
 
 // Set literal: elementos son CExp (seman.: deben ser INT)
-struct CExp; // fwd
 struct SetLiteralExp : SetExp {
     std::vector<CExp*> elems;
     explicit SetLiteralExp(std::vector<CExp*> es):elems(std::move(es)){}
+    ~SetLiteralExp();
     Value accept(Visitor* v) override;
 };
 
@@ -46,24 +64,28 @@ struct CExp {
     SetExp* s = nullptr;   // si no es null => SetExpr
     explicit CExp(Exp* e): a(e) {}
     explicit CExp(SetExp* z): s(z) {}
+    ~CExp(){ liberar(a); liberar(s); }
     Value accept(Visitor* v); // delega
 };
 
 // ---- sentencias y programa
 struct Stm { virtual ~Stm(){}; virtual void accept(Visitor* v)=0; };
-struct AssignStm : Stm { std::string id; CExp* rhs; AssignStm(std::string i, CExp* r):id(std::move(i)),rhs(r){} void accept(Visitor* v) override; };
-struct PrintStm  : Stm { CExp* e; PrintStm(CExp* x):e(x){} void accept(Visitor* v) override; };
-struct Program   { std::vector<Stm*> slist; };
+struct AssignStm : Stm { std::string id; CExp* rhs; AssignStm(std::string i, CExp* r):id(std::move(i)),rhs(r){} ~AssignStm(){ liberar(rhs); } void accept(Visitor* v) override; };
+struct PrintStm  : Stm { CExp* e; PrintStm(CExp* x):e(x){} ~PrintStm(){ liberar(e); } void accept(Visitor* v) override; };
+struct Program   { std::vector<Stm*> slist; ~Program(){ for (auto s : slist) delete s; } };
 
 struct Visitor {
     virtual Value visit(NumberExp*)=0;
     virtual Value visit(IdExp*)=0;
     virtual Value visit(BinaryExp*)=0;
     virtual Value visit(SqrtExp*)=0;
+    virtual Value visit(CardExp*)=0;
+    virtual Value visit(JaccardExp*)=0;
     virtual Value visit(SetIdExp*)=0;
     virtual Value visit(SetParenExp*)=0;
     virtual Value visit(SetBinaryExp*)=0;
     virtual Value visit(SetLiteralExp*)=0;
+    virtual Value visit(ApproxExp*)=0;
 
     // helpers para stmts
     virtual void visit(AssignStm*)=0;
@@ -0,0 +1,90 @@
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+# Compara card/cup/cap/\/jaccard aproximados contra los exactos sobre conjuntos generados
+
+# Archivos c++
+programa = ["main.cpp", "scanner.cpp", "token.cpp", "parser.cpp", "ast.cpp", "visitor.cpp", "server.cpp", "sketch.cpp", "incremental.cpp"]
+
+# Compilar
+compile = ["g++", "-O2"] + programa + ["-pthread"]
+print("Compilando:", " ".join(compile))
+result = subprocess.run(compile, capture_output=True, text=True)
+
+if result.returncode != 0:
+    print("Error en compilación:\n", result.stderr)
+    exit(1)
+
+print("Compilación exitosa")
+
+# Casos: (|A|, |B|, |A cap B|). El error por defecto de approx es 2%
+casos = [
+    (200000, 250000, 100000),
+    (250000, 250000, 0),
+    (50000, 250000, 50000),   # A dentro de B
+    (1000, 800, 300),         # chico: el sketch todavía es exacto
+]
+
+# Tolerancias: card y cup relativas al valor exacto; cap y \ relativas a |A cup B|
+# (el error de MinHash escala con la unión); jaccard en puntos porcentuales
+TOL_CARD = 0.06
+TOL_UNION = 0.06
+TOL_CAP_DIFF = 0.05
+TOL_JACCARD = 3
+
+random.seed(26)
+fallas = 0
+
+with tempfile.TemporaryDirectory() as tmp:
+    for i, (na, nb, comun) in enumerate(casos, 1):
+        universo = random.sample(range(2**31 - 1), na + nb - comun)
+        A = universo[:na]
+        B = universo[na - comun:]
+        random.shuffle(B)
+
+        # x pasa por un set exacto; y se arma directo desde el literal
+        codigo = (
+            "a = {" + ",".join(map(str, A)) + "};\n"
+            "b = {" + ",".join(map(str, B)) + "};\n"
+            "x = approx(a);\n"
+            "y = approx({" + ",".join(map(str, B)) + "});\n"
+            "print(card(a)); print(card(x));\n"
+            "print(card(a cup b)); print(card(x cup y));\n"
+            "print(card(a cap b)); print(card(x cap y));\n"
+            "print(card(a \\ b)); print(card(x \\ y));\n"
+            "print(jaccard(a, b)); print(jaccard(x, y))\n"
+        )
+        filepath = os.path.join(tmp, f"sketch{i}.txt")
+        with open(filepath, "w", encoding="utf-8") as f:
+            f.write(codigo)
+
+        run_cmd = ["./a.out", filepath, "--out", os.path.join(tmp, "ast.dot"), "--max-nodes", "100"]
+        result = subprocess.run(run_cmd, capture_output=True, text=True)
+        valores = [int(x) for x in result.stdout.split()]
+        if result.returncode != 0 or len(valores) != 10:
+            print(f"Caso {i}: ejecución fallida\n", result.stdout, result.stderr)
+            fallas += 1
+            continue
+
+        union = valores[2]
+        chequeos = [
+            ("card", valores[0], valores[1], TOL_CARD * valores[0]),
+            ("cup", valores[2], valores[3], TOL_UNION * union),
+            ("cap", valores[4], valores[5], TOL_CAP_DIFF * union),
+            ("diff", valores[6], valores[7], TOL_CAP_DIFF * union),
+            ("jaccard", valores[8], valores[9], TOL_JACCARD),
+        ]
+        print(f"Caso {i}: |A|={na} |B|={nb} |A cap B|={comun}")
+        for nombre, exacto, aprox, tol in chequeos:
+            ok = abs(aprox - exacto) <= tol
+            if not ok:
+                fallas += 1
+            print(f"  {nombre:8} exacto={exacto:<8} aprox={aprox:<8} tol={tol:<10.0f} {'OK' if ok else 'FALLA'}")
+
+if fallas:
+    print(f"{fallas} chequeos fallaron")
+    sys.exit(1)
+print("Todas las estimaciones dentro de tolerancia")
@@ -0,0 +1,281 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <thread>
+#include <sys/stat.h>
+#include "scanner.h"
+#include "parser.h"
+#include "ast.h"
+#include "visitor.h"
+#include "incremental.h"
+
+using namespace std;
+
+// -----------------------------
+// Variables que lee una sentencia
+// -----------------------------
+
+struct LecturasVisitor : Visitor {
+    vector<string> lee;
+
+    void leer(const string& id) {
+        for (auto& x : lee) if (x == id) return;
+        lee.push_back(id);
+    }
+
+    Value visit(NumberExp*) override { return Value::fromInt(0); }
+    Value visit(IdExp* e) override { leer(e->name); return Value::fromInt(0); }
+    Value visit(BinaryExp* e) override { e->left->accept(this); e->right->accept(this); return Value::fromInt(0); }
+    Value visit(SqrtExp* e) override { e->inner->accept(this); return Value::fromInt(0); }
+    Value visit(CardExp* e) override { e->inner->accept(this); return Value::fromInt(0); }
+    Value visit(JaccardExp* e) override { e->left->accept(this); e->right->accept(this); return Value::fromInt(0); }
+
+    Value visit(SetIdExp* e) override { leer(e->name); return Value::fromInt(0); }
+    Value visit(SetParenExp* e) override { e->inner->accept(this); return Value::fromInt(0); }
+    Value visit(SetBinaryExp* e) override { e->left->accept(this); e->right->accept(this); return Value::fromInt(0); }
+    Value visit(SetLiteralExp* e) override { for (auto c : e->elems) c->accept(this); return Value::fromInt(0); }
+    Value visit(ApproxExp* e) override { e->inner->accept(this); if (e->err) e->err->accept(this); return Value::fromInt(0); }
+
+    void visit(AssignStm* s) override { s->rhs->accept(this); }
+    void visit(PrintStm* s) override { s->e->accept(this); }
+};
+
+// -----------------------------
+// Estado cacheado por sentencia
+// -----------------------------
+
+struct Sentencia {
+    string texto;
+    size_t fin = 0;           // posición de su ';' (o del final del archivo) en la fuente
+    unique_ptr<Stm> stm;      // null si no parseó
+    vector<int> lee;          // variables como ids (ver Incremental::id)
+    vector<Sentencia*> fuentes; // quién escribió cada variable de `lee` en la última ejecución
+    int escribe = -1;         // variable asignada (-1 si es print)
+    Value valor = Value::fromInt(0); // lo que quedó en `escribe` la última vez
+    bool ok = false;          // la última ejecución terminó sin error
+    bool pendiente = true;    // nunca se ejecutó, o quedó después de un error
+    unsigned pasada = 0;      // última pasada en que se ejecutó
+    string error;
+    string salida;
+};
+
+struct Trozo {
+    string texto;
+    size_t fin;
+};
+
+// Corta fuente[ini, fin) en ';' y descarta trozos vacíos (fuera de SEMICOL no hay ';' en
+// el lenguaje). El fin de cada trozo es la posición de su ';', o `fin` para el último.
+static vector<Trozo> dividir(const string& fuente, size_t ini, size_t fin) {
+    vector<Trozo> trozos;
+    while (ini <= fin) {
+        const char* q = (const char*)memchr(fuente.data() + ini, ';', fin - ini);
+        size_t corte = q ? q - fuente.data() : fin;
+        size_t a = fuente.find_first_not_of(" \t\r\n", ini);
+        if (a != string::npos && a < corte) {
+            size_t b = fuente.find_last_not_of(" \t\r\n", corte - 1);
+            trozos.push_back({fuente.substr(a, b - a + 1), corte});
+        }
+        ini = corte + 1;
+    }
+    return trozos;
+}
+
+class Incremental {
+    string fuente;            // la versión de la última pasada
+    vector<unique_ptr<Sentencia>> sents;
+    unordered_map<string, int> ids;
+    vector<string> nombres;
+    EvalVisitor eval;
+    ostringstream salida;
+    unsigned pasada = 0;
+
+    int id(const string& nombre) {
+        auto it = ids.find(nombre);
+        if (it != ids.end()) return it->second;
+        ids.emplace(nombre, (int)nombres.size());
+        nombres.push_back(nombre);
+        return (int)nombres.size() - 1;
+    }
+
+    unique_ptr<Sentencia> parsear(const string& texto) {
+        unique_ptr<Sentencia> s(new Sentencia());
+        s->texto = texto;
+        try {
+            Scanner scanner(texto.c_str());
+            Parser parser(&scanner);
+            unique_ptr<Program> prog(parser.parseProgram());
+            s->stm.reset(prog->slist[0]);
+            prog->slist.clear();
+        } catch (const exception& e) {
+            s->error = string("Error al parsear: ") + e.what();
+            return s;
+        }
+        LecturasVisitor lecturas;
+        s->stm->accept(&lecturas);
+        for (auto& v : lecturas.lee) s->lee.push_back(id(v));
+        if (auto a = dynamic_cast<AssignStm*>(s->stm.get())) s->escribe = id(a->id);
+        return s;
+    }
+
+    // Ejecuta una sentencia con solo las variables que lee, tomadas de su último escritor
+    void ejecutar(Sentencia& s, const vector<Sentencia*>& escritor) {
+        s.ok = false;
+        s.pendiente = false;
+        s.pasada = pasada;
+        s.salida.clear();
+        if (!s.stm) return;
+        eval.mem.clear();
+        s.fuentes.clear();
+        for (int v : s.lee) {
+            s.fuentes.push_back(escritor[v]);
+            if (escritor[v]) eval.mem[nombres[v]] = escritor[v]->valor;
+        }
+        try {
+            s.stm->accept(&eval);
+            s.error.clear();
+            s.ok = true;
+            if (s.escribe >= 0) s.valor = move(eval.mem[nombres[s.escribe]]);
+        } catch (const exception& e) {
+            s.error = string("Error en ejecución: ") + e.what();
+        }
+        s.salida = salida.str();
+        salida.str("");
+    }
+
+    // Reemplaza las sentencias tocadas por la edición. Devuelve cuántas se reparsearon.
+    size_t reemplazar(const string& nueva) {
+        // Bytes distintos respecto de la versión anterior: [p, n0 - s) pasó a ser [p, n1 - s)
+        size_t n0 = fuente.size(), n1 = nueva.size(), lim = min(n0, n1);
+        size_t p = mismatch(fuente.begin(), fuente.begin() + lim, nueva.begin()).first - fuente.begin();
+        size_t s = 0;
+        while (s < lim - p && fuente[n0 - 1 - s] == nueva[n1 - 1 - s]) s++;
+
+        // Se extiende a sentencias enteras: del ';' anterior al siguiente, que son iguales en ambas
+        size_t ini = p, fin = n0 - s;
+        while (ini > 0 && fuente[ini - 1] != ';') ini--;
+        while (fin < n0 && fuente[fin] != ';') fin++;
+        size_t finNueva = fin + n1 - n0;
+
+        auto porFin = [](const unique_ptr<Sentencia>& x, size_t pos){ return x->fin < pos; };
+        size_t i0 = lower_bound(sents.begin(), sents.end(), ini, porFin) - sents.begin();
+        size_t i1 = lower_bound(sents.begin(), sents.end(), fin + 1, porFin) - sents.begin();
+
+        // Dentro del tramo, las que no cambiaron se reconocen por su texto
+        unordered_map<string, vector<unique_ptr<Sentencia>>> viejas;
+        for (size_t i = i1; i-- > i0; ) viejas[sents[i]->texto].push_back(move(sents[i]));
+        vector<Trozo> trozos = dividir(nueva, ini, finNueva);
+        vector<unique_ptr<Sentencia>> nuevas;
+        size_t reparseadas = 0;
+        for (auto& t : trozos) {
+            auto it = viejas.find(t.texto);
+            if (it != viejas.end() && !it->second.empty()) {
+                nuevas.push_back(move(it->second.back()));
+                it->second.pop_back();
+            } else {
+                nuevas.push_back(parsear(t.texto));
+                reparseadas++;
+            }
+            nuevas.back()->fin = t.fin;
+        }
+        // Lo que quedó en `viejas` se borró del archivo; se libera recién al salir, cuando
+        // ya se cargaron las nuevas, para que ninguna reciba la dirección de una borrada
+        // y un puntero viejo en `fuentes` la confunda con su escritor
+
+        sents.erase(sents.begin() + i0, sents.begin() + i1);
+        sents.insert(sents.begin() + i0, make_move_iterator(nuevas.begin()), make_move_iterator(nuevas.end()));
+        for (size_t i = i0 + nuevas.size(); i < sents.size(); i++) sents[i]->fin = sents[i]->fin + n1 - n0;
+        fuente = nueva;
+        return reparseadas;
+    }
+
+public:
+    Incremental() { eval.out = &salida; }
+
+    void actualizar(const string& nueva, ostream& os) {
+        auto t0 = chrono::steady_clock::now();
+        pasada++;
+        size_t reparseadas = reemplazar(nueva);
+        size_t m = sents.size();
+
+        // Recorrido en orden: se re-ejecuta lo pendiente y lo que ve un escritor distinto
+        // (otra sentencia, o la misma re-ejecutada en esta pasada) para alguna variable que lee
+        vector<Sentencia*> escritor(nombres.size(), nullptr);
+        size_t rehechas = 0;
+        for (size_t i = 0; i < m; i++) {
+            Sentencia& s = *sents[i];
+            bool afectada = s.pendiente;
+            for (size_t j = 0; j < s.lee.size() && !afectada; j++) {
+                Sentencia* w = escritor[s.lee[j]];
+                afectada = w != s.fuentes[j] || (w && w->pasada == pasada);
+            }
+
+            if (afectada) {
+                ejecutar(s, escritor);
+                rehechas++;
+                istringstream lineas(s.salida);
+                string linea;
+                while (getline(lineas, linea)) os << "[" << i << "] " << linea << "\n";
+            }
+            if (!s.ok) {
+                // Igual que una corrida completa: nada después del primer error se ejecuta
+                os << "[" << i << "] " << s.error << "\n";
+                for (size_t k = i + 1; k < m; k++) sents[k]->pendiente = true;
+                break;
+            }
+            if (s.escribe >= 0) escritor[s.escribe] = &s;
+        }
+
+        long us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+        os << "-- " << rehechas << " de " << m << " sentencias re-ejecutadas, "
+           << reparseadas << " reparseadas (" << us << " us) --" << endl;
+    }
+};
+
+// -----------------------------
+// Bucle de vigilancia
+// -----------------------------
+
+// Un guardado no es atómico (truncar y escribir, o escribir aparte y renombrar):
+// se lee recién cuando tamaño y mtime se repiten en dos sondeos seguidos, y si el
+// archivo no está por un momento se sigue esperando en vez de salir.
+int ejecutar_watch(const string& archivo) {
+    Incremental inc;
+    struct timespec leida{}, vista{};
+    off_t tamLeido = -1, tamVisto = -1;
+    bool falta = false;
+    cout << "Vigilando " << archivo << " (Ctrl-C para salir)" << endl;
+
+    while (true) {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        struct stat st;
+        if (stat(archivo.c_str(), &st) != 0) {
+            if (!falta) cerr << "No se pudo abrir el archivo: " << archivo << " (reintentando)" << endl;
+            falta = true;
+            tamVisto = -1;
+            continue;
+        }
+        falta = false;
+
+        bool igualLeida = st.st_mtim.tv_sec == leida.tv_sec && st.st_mtim.tv_nsec == leida.tv_nsec && st.st_size == tamLeido;
+        bool estable = st.st_mtim.tv_sec == vista.tv_sec && st.st_mtim.tv_nsec == vista.tv_nsec && st.st_size == tamVisto;
+        vista = st.st_mtim;
+        tamVisto = st.st_size;
+        if (igualLeida || !estable) continue;
+
+        ifstream infile(archivo);
+        if (!infile) continue;
+        ostringstream ss;
+        ss << infile.rdbuf();
+        leida = st.st_mtim;
+        tamLeido = st.st_size;
+        inc.actualizar(ss.str(), cout);
+    }
+}
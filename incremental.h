@@ -0,0 +1,32 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <string>
+using namespace std;
+
+// -----------------------------
+// Modo watch con re-evaluación incremental
+// -----------------------------
+//
+// Vigila el archivo y en cada cambio:
+//   - compara los bytes contra la versión anterior y toma el tramo distinto, extendido
+//     hasta el ';' de cada lado; solo ese tramo se vuelve a cortar en sentencias
+//   - dentro del tramo busca cada sentencia por su texto, así dos ediciones lejanas
+//     entre sí no re-ejecutan lo del medio (aunque sí lo vuelven a cortar)
+//   - reparsea solo las sentencias nuevas o cambiadas
+//   - re-ejecuta solo esas y las que, para alguna variable que leen, ahora ven otro
+//     escritor o uno re-ejecutado (el resto reutiliza el valor que ya había calculado)
+//
+// Solo se imprime la salida de las sentencias re-ejecutadas, con su índice.
+// Lo que sigue siendo lineal en el tamaño del archivo es barato: leerlo y compararlo
+// byte a byte, y una pasada por todas las sentencias comparando punteros para ver
+// cuáles leen una variable cuyo escritor cambió.
+// Como en una corrida completa, la primera sentencia que falla corta la pasada: su
+// error se imprime en cada pasada y las siguientes quedan sin ejecutar hasta que se
+// corrija. A diferencia de la corrida completa, un error de parseo no impide correr
+// las sentencias anteriores a él.
+
+// No retorna: si el archivo desaparece (guardado por renombre) sigue esperando.
+int ejecutar_watch(const string& archivo);
+
+#endif // INCREMENTAL_H
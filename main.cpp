@@ -5,14 +5,46 @@
 #include "parser.h"
 #include "ast.h"
 #include "visitor.h"
+#include "server.h"
+#include "incremental.h"
 
 using namespace std;
 
 int main(int argc, const char* argv[]) {
+    // Modo servidor / cliente sobre socket Unix
+    if (argc >= 3 && string(argv[1]) == "--serve") {
+        int workers = argc >= 4 ? atoi(argv[3]) : 4;
+        return ejecutar_servidor(argv[2], workers);
+    }
+    if ((argc == 4 || argc == 5) && string(argv[1]) == "--client") {
+        return ejecutar_cliente(argv[2], argv[3], argc == 5 ? argv[4] : "-");
+    }
+    // Re-evaluación incremental al editar el archivo
+    if (argc == 3 && string(argv[1]) == "--watch") {
+        return ejecutar_watch(argv[2]);
+    }
+
+    // Opciones del AST (después del archivo de entrada)
+    PrintVisitor impresion;
+    bool opcionesOk = argc >= 2;
+    for (int i = 2; i < argc && opcionesOk; i++) {
+        string op = argv[i];
+        bool conValor = i + 1 < argc;
+        if (op == "--out" && conValor)            impresion.ruta = argv[++i];
+        else if (op == "--max-depth" && conValor) impresion.maxProfundidad = atoi(argv[++i]);
+        else if (op == "--max-nodes" && conValor) impresion.maxNodos = atoi(argv[++i]);
+        else if (op == "--share")                 impresion.compartir = true;
+        else if (op == "--json")                  impresion.json = true;
+        else opcionesOk = false;
+    }
+
     // Verificar número de argumentos
-    if (argc != 2) {
+    if (!opcionesOk) {
         cout << "Número incorrecto de argumentos.\n";
-        cout << "Uso: " << argv[0] << " <archivo_de_entrada>" << endl;
+        cout << "Uso: " << argv[0] << " <archivo_de_entrada> [--out ruta] [--max-depth N] [--max-nodes N] [--share] [--json]" << endl;
+        cout << "     " << argv[0] << " --serve <socket> [hilos]" << endl;
+        cout << "     " << argv[0] << " --client <socket> <sesion|--stats> [archivo]" << endl;
+        cout << "     " << argv[0] << " --watch <archivo>" << endl;
         return 1;
     }
 
@@ -51,10 +83,9 @@ int main(int argc, const char* argv[]) {
     }
 
 
-    PrintVisitor impresion;
     impresion.imprimir(ast);
     
-    EVALVisitor interprete;
+    EvalVisitor interprete;
     interprete.interprete(ast);
 
     return 0;
@@ -2,13 +2,37 @@
 #include <stdexcept>
 #include <cstdlib>
 #include <string>
+#include <memory>
 #include "token.h"
 #include "scanner.h"
 #include "ast.h"
 #include "parser.h"
 using namespace std;
 
+// Parsear, evaluar e imprimir el árbol son recursivos: algo más hondo que esto desbordaría
+// la pila (también la de los hilos del servidor), así que se rechaza como error de parseo.
+// Cada eslabón de una cadena a+b+... y cada factor anidado cuenta un nivel.
+static const int MAX_ANIDAMIENTO = 20000;
+
+namespace {
+struct Nivel {
+    int& prof;
+    int base;
+    explicit Nivel(int& p): prof(p), base(p) { mas(); }
+    ~Nivel(){ prof = base; }
+    void mas(){ if (++prof > MAX_ANIDAMIENTO) throw runtime_error("Expresión demasiado anidada"); }
+};
+}
+
 Parser::Parser(Scanner* s):scanner(s),current(nullptr),previous(nullptr){ advance(); }
+Parser::~Parser(){ delete previous; delete current; delete look; }
+
+void Parser::reiniciar(){
+    delete previous; delete current; delete look;
+    previous = current = look = nullptr;
+    profundidad = 0;
+    advance();
+}
 
 bool Parser::check(Token::Type t) const { return current && current->type==t; }
 bool Parser::match(Token::Type t){ if (check(t)){ advance(); return true; } return false; }
@@ -21,6 +45,7 @@ Token* Parser::peek() {
 }
 
 bool Parser::advance() {
+    delete previous; // ya nadie lo usa: solo se consulta el último token consumido
     previous = current;
     if (look) { current = look; look = nullptr; }
     else { current = scanner->nextToken(); }
@@ -28,22 +53,23 @@ bool Parser::advance() {
 }
 
 Program* Parser::parseProgram(){
-    auto* prog = new Program();
+    // Los nodos a medio armar van en unique_ptr: tras un error de parseo no queda nada colgado
+    unique_ptr<Program> prog(new Program());
     prog->slist.push_back(parseStm());
     while (match(Token::SEMICOL)) {
         if (isAtEnd()) break;
         prog->slist.push_back(parseStm());
     }
     if (!isAtEnd()) throw runtime_error("Basura después del último statement");
-    return prog;
+    return prog.release();
 }
 
 Stm* Parser::parseStm(){
     if (match(Token::PRINT)) {
         consume(Token::LPAREN, "Se esperaba '(' tras print");
-        CExp* e = parseCExp();
+        unique_ptr<CExp> e(parseCExp());
         consume(Token::RPAREN, "Se esperaba ')' al cerrar print(");
-        return new PrintStm(e);
+        return new PrintStm(e.release());
     }
     if (match(Token::ID)) {
         string name = previous->text;
@@ -56,8 +82,9 @@ Stm* Parser::parseStm(){
 
 // ---------- CExp ----------
 CExp* Parser::parseCExp() {
-    // 1) Set literal obvio
-    if (check(Token::LBRACE)) {
+    Nivel nivel(profundidad);
+    // 1) Set literal obvio (o conjunto aproximado)
+    if (check(Token::LBRACE) || check(Token::APPROX)) {
         return new CExp(parseSetExpr());
     }
 
@@ -65,7 +92,7 @@ CExp* Parser::parseCExp() {
     if (check(Token::LPAREN)) {
         Token* t1 = peek();
         // Si lo siguiente es '{', interpretamos como (SetExpr)
-        if (t1 && t1->type == Token::LBRACE) {
+        if (t1 && (t1->type == Token::LBRACE || t1->type == Token::APPROX)) {
             return new CExp(parseSetExpr());
         }
         // En caso contrario, lo tratamos como Expr
@@ -91,63 +118,87 @@ CExp* Parser::parseCExp() {
 
 // ---------- Expr ----------
 Exp* Parser::parseExpr(){
-    Exp* left = parseTerm();
+    Nivel nivel(profundidad);
+    unique_ptr<Exp> left(parseTerm());
     while (match(Token::PLUS) || match(Token::MINUS)) {
         BinaryOp op = (previous->type==Token::PLUS)?PLUS_OP:MINUS_OP;
+        nivel.mas();
         Exp* right = parseTerm();
-        left = new BinaryExp(left,right,op);
+        left.reset(new BinaryExp(left.release(),right,op));
     }
-    return left;
+    return left.release();
 }
 
 Exp* Parser::parseTerm(){
-    Exp* left = parseFactor();
+    Nivel nivel(profundidad);
+    unique_ptr<Exp> left(parseFactor());
     while (match(Token::MUL) || match(Token::DIV)) {
         BinaryOp op = (previous->type==Token::MUL)?MUL_OP:DIV_OP;
+        nivel.mas();
         Exp* right = parseFactor();
-        left = new BinaryExp(left,right,op);
+        left.reset(new BinaryExp(left.release(),right,op));
     }
-    return left;
+    return left.release();
 }
 
 Exp* Parser::parseFactor(){
+    Nivel nivel(profundidad);
     if (match(Token::MINUS)) {
         Exp* inner = parseFactor();
         return new BinaryExp(new NumberExp(0), inner, MINUS_OP);
     }
     if (match(Token::NUM))    return new NumberExp(std::atoi(previous->text.c_str()));
     if (match(Token::ID))     return new IdExp(previous->text);
-    if (match(Token::SQRT)) { consume(Token::LPAREN,"Se esperaba '(' tras sqrt"); Exp* e=parseExpr(); consume(Token::RPAREN,"Falta ')'"); return new SqrtExp(e); }
-    if (match(Token::LPAREN)) { Exp* e = parseExpr(); consume(Token::RPAREN,"Falta ')'"); return e; }
+    if (match(Token::SQRT)) { consume(Token::LPAREN,"Se esperaba '(' tras sqrt"); unique_ptr<Exp> e(parseExpr()); consume(Token::RPAREN,"Falta ')'"); return new SqrtExp(e.release()); }
+    if (match(Token::CARD)) { consume(Token::LPAREN,"Se esperaba '(' tras card"); unique_ptr<SetExp> s(parseSetExpr()); consume(Token::RPAREN,"Falta ')'"); return new CardExp(s.release()); }
+    if (match(Token::JACCARD)) {
+        consume(Token::LPAREN,"Se esperaba '(' tras jaccard");
+        unique_ptr<SetExp> l(parseSetExpr());
+        consume(Token::COMMA,"Se esperaba ',' en jaccard");
+        unique_ptr<SetExp> r(parseSetExpr());
+        consume(Token::RPAREN,"Falta ')'");
+        return new JaccardExp(l.release(), r.release());
+    }
+    if (match(Token::LPAREN)) { unique_ptr<Exp> e(parseExpr()); consume(Token::RPAREN,"Falta ')'"); return e.release(); }
     throw runtime_error("Factor inválido");
 }
 
 // ---------- SetExpr ----------
 SetExp* Parser::parseSetExpr(){
-    SetExp* left = parseSetTerm();
+    Nivel nivel(profundidad);
+    unique_ptr<SetExp> left(parseSetTerm());
     while (match(Token::UNION) || match(Token::INTERSECT) || match(Token::DIFF)) {
         SetOp op = (previous->type==Token::UNION)?UNION_OP : (previous->type==Token::INTERSECT)?INTERSECT_OP : DIFF_OP;
+        nivel.mas();
         SetExp* right = parseSetTerm();
-        left = new SetBinaryExp(left,right,op);
+        left.reset(new SetBinaryExp(left.release(),right,op));
     }
-    return left;
+    return left.release();
 }
 SetExp* Parser::parseSetTerm(){ return parseSetFactor(); }
 
 SetExp* Parser::parseSetFactor(){
+    Nivel nivel(profundidad);
     if (check(Token::LBRACE)) return parseSet();
+    if (match(Token::APPROX)) {
+        consume(Token::LPAREN,"Se esperaba '(' tras approx");
+        unique_ptr<SetExp> inner(parseSetExpr());
+        unique_ptr<Exp> err(match(Token::COMMA) ? parseExpr() : nullptr);
+        consume(Token::RPAREN,"Falta ')' en approx");
+        return new ApproxExp(inner.release(), err.release());
+    }
     if (match(Token::ID))     return new SetIdExp(previous->text);
-    if (match(Token::LPAREN)) { SetExp* inner = parseSetExpr(); consume(Token::RPAREN,"Falta ')' en (SetExpr)"); return new SetParenExp(inner); }
+    if (match(Token::LPAREN)) { unique_ptr<SetExp> inner(parseSetExpr()); consume(Token::RPAREN,"Falta ')' en (SetExpr)"); return new SetParenExp(inner.release()); }
     throw runtime_error("SetFactor inválido");
 }
 
 SetExp* Parser::parseSet(){
     consume(Token::LBRACE,"Falta '{'");
-    std::vector<CExp*> elems;
+    unique_ptr<SetLiteralExp> lit(new SetLiteralExp({}));
     if (!check(Token::RBRACE)) {
-        elems.push_back(parseCExp());
-        while (match(Token::COMMA)) elems.push_back(parseCExp());
+        lit->elems.push_back(parseCExp());
+        while (match(Token::COMMA)) lit->elems.push_back(parseCExp());
     }
     consume(Token::RBRACE,"Falta '}'");
-    return new SetLiteralExp(std::move(elems));
+    return lit.release();
 }
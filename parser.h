@@ -8,6 +8,7 @@ class Parser {
     Scanner* scanner;
     Token *current, *previous;
     Token *look = nullptr;
+    int profundidad = 0;   // niveles de anidamiento abiertos (ver Nivel en parser.cpp)
 
     bool match(Token::Type t);
     bool check(Token::Type t) const;
@@ -17,6 +18,10 @@ class Parser {
 
 public:
     Parser(Scanner* s);
+    ~Parser();
+
+    // Descarta los tokens que tenga y empieza de nuevo (tras Scanner::reiniciar)
+    void reiniciar();
 
     Program* parseProgram();
     Stm* parseStm();
@@ -3,10 +3,10 @@ import subprocess
 import shutil
 
 # Archivos c++
-programa = ["main.cpp", "scanner.cpp", "token.cpp", "parser.cpp", "ast.cpp", "visitor.cpp"]
+programa = ["main.cpp", "scanner.cpp", "token.cpp", "parser.cpp", "ast.cpp", "visitor.cpp", "server.cpp", "sketch.cpp", "incremental.cpp"]
 
 # Compilar
-compile = ["g++"] + programa
+compile = ["g++"] + programa + ["-pthread"]
 print("Compilando:", " ".join(compile))
 result = subprocess.run(compile, capture_output=True, text=True)
 
@@ -27,7 +27,8 @@ for i in range(1, 11):
 
     if os.path.isfile(filepath):
         print(f"Ejecutando {filename}")
-        run_cmd = ["./a.out", filepath]
+        dest_ast = os.path.join(output_dir, f"ast_{i}.dot")
+        run_cmd = ["./a.out", filepath, "--out", dest_ast]
         result = subprocess.run(run_cmd, capture_output=True, text=True)
 
         # Guardar stdout y stderr
@@ -40,18 +41,14 @@ for i in range(1, 11):
 
         # Archivos generados
         tokens_file = os.path.join(input_dir, f"input{i}_tokens.txt")  # se crea en inputs/
-        ast_file = "ast.dot"  # se crea en raíz del proyecto
 
         # Mover archivo de tokens si existe
         if os.path.isfile(tokens_file):
             dest_tokens = os.path.join(output_dir, f"tokens_{i}.txt")
             shutil.move(tokens_file, dest_tokens)
 
-        # Mover y convertir AST si existe
-        if os.path.isfile(ast_file):
-            dest_ast = os.path.join(output_dir, f"ast_{i}.dot")
-            shutil.move(ast_file, dest_ast)
-
+        # Convertir AST si se generó (se escribe directo en outputs/)
+        if os.path.isfile(dest_ast):
             # Convertir a PNG
             output_img = os.path.join(output_dir, f"ast_{i}.png")
             dot_cmd = ["dot", "-Tpng", dest_ast, "-o", output_img]
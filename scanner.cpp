@@ -13,6 +13,13 @@ using namespace std;
 Scanner::Scanner(const char* s): input(s), first(0), current(0) { 
     }
 
+void Scanner::reiniciar(const string& s) {
+    // Un script enorme no deja su buffer retenido para siempre
+    if (input.capacity() > (1u << 20) && s.size() < input.capacity() / 4) string().swap(input);
+    input.assign(s);
+    first = current = 0;
+}
+
 // -----------------------------
 // Función auxiliar
 // -----------------------------
@@ -56,6 +63,9 @@ Token* Scanner::nextToken() {
         if (lex == "sqrt")  return new Token(Token::SQRT , input, first, lex.size()); // opcional
         if (lex == "cup")   return new Token(Token::UNION, input, first, lex.size());
         if (lex == "cap")   return new Token(Token::INTERSECT, input, first, lex.size());
+        if (lex == "approx")  return new Token(Token::APPROX, input, first, lex.size());
+        if (lex == "card")    return new Token(Token::CARD, input, first, lex.size());
+        if (lex == "jaccard") return new Token(Token::JACCARD, input, first, lex.size());
         return new Token(Token::ID, input, first, lex.size());
     }
     // Operadores
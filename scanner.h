@@ -15,6 +15,9 @@ public:
     // Constructor
     Scanner(const char* in_s);
 
+    // Vuelve a empezar sobre otra entrada reutilizando el buffer (lo usa el servidor)
+    void reiniciar(const string& in_s);
+
     // Retorna el siguiente token
     Token* nextToken();
 
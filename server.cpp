@@ -0,0 +1,478 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/time.h>
+#include "scanner.h"
+#include "parser.h"
+#include "ast.h"
+#include "visitor.h"
+#include "server.h"
+
+using namespace std;
+
+// -----------------------------
+// Utilidades de socket
+// -----------------------------
+
+static bool enviar(int fd, const string& s) {
+    size_t hecho = 0;
+    while (hecho < s.size()) {
+        ssize_t n = send(fd, s.data() + hecho, s.size() - hecho, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        hecho += n;
+    }
+    return true;
+}
+
+// Lectura de líneas con buffer propio (lo usa el cliente)
+struct Lector {
+    int fd;
+    string buf;
+    size_t pos = 0;
+
+    explicit Lector(int f): fd(f) {}
+
+    bool llenar() {
+        if (pos > 0) { buf.erase(0, pos); pos = 0; }
+        char tmp[4096];
+        ssize_t n = read(fd, tmp, sizeof(tmp));
+        if (n <= 0) return false;
+        buf.append(tmp, n);
+        return true;
+    }
+    bool linea(string& out) {
+        while (true) {
+            size_t nl = buf.find('\n', pos);
+            if (nl != string::npos) {
+                out.assign(buf, pos, nl - pos);
+                pos = nl + 1;
+                return true;
+            }
+            if (!llenar()) return false;
+        }
+    }
+};
+
+static int conectar(const string& path, bool escuchar) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) { close(fd); return -1; }
+    strcpy(addr.sun_path, path.c_str());
+    if (escuchar) {
+        // Solo se reemplaza un socket viejo; cualquier otro archivo se deja en paz
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) { close(fd); errno = EEXIST; return -1; }
+            unlink(path.c_str());
+        }
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0) { close(fd); return -1; }
+    } else {
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
+    }
+    return fd;
+}
+
+// -----------------------------
+// Estado compartido del servidor
+// -----------------------------
+
+// Petición completa ya leída por el hilo de E/S
+struct Peticion {
+    int fd;
+    string op, nombre, codigo;
+    chrono::steady_clock::time_point llegada; // al encolarla: la latencia incluye la espera
+};
+
+// Las peticiones de una sesión se atienden de a una, en orden de llegada. La sesión
+// entra a la cola de listas solo cuando tiene algo pendiente y ningún hilo la atiende,
+// así un hilo nunca queda esperando a que otro suelte una sesión.
+struct Sesion {
+    unordered_map<string, Value> mem;   // solo la toca el hilo que la atiende
+    queue<Peticion> pendientes;         // protegidas por mCola
+    bool atendida = false;              // está en la cola de listas o en un hilo
+};
+
+class Servidor {
+    mutex mSesiones;
+    unordered_map<string, unique_ptr<Sesion>> sesiones;
+
+    // Últimas latencias (microsegundos) en un buffer circular
+    static const size_t MAX_MUESTRAS = 4096;
+    mutex mLat;
+    vector<long> latencias;
+    size_t siguiente = 0;
+
+    mutex mCola;
+    condition_variable cv;
+    queue<Sesion*> listas;
+    bool parar = false;
+
+public:
+    int aviso[2];  // los trabajadores avisan por aquí al hilo de E/S que terminaron
+
+    Sesion& sesion(const string& nombre) {
+        lock_guard<mutex> lk(mSesiones);
+        auto& s = sesiones[nombre];
+        if (!s) s.reset(new Sesion());
+        return *s;
+    }
+
+    void registrar(long us) {
+        lock_guard<mutex> lk(mLat);
+        if (latencias.size() < MAX_MUESTRAS) latencias.push_back(us);
+        else latencias[siguiente] = us;
+        siguiente = (siguiente + 1) % MAX_MUESTRAS;
+    }
+
+    string estadisticas() {
+        vector<long> v;
+        { lock_guard<mutex> lk(mLat); v = latencias; }
+        ostringstream os;
+        os << "STATS n=" << v.size();
+        if (v.empty()) return os.str() + "\n";
+        sort(v.begin(), v.end());
+        auto p = [&](int q){ return v[(v.size() - 1) * q / 100]; };
+        os << " p50=" << p(50) << " p90=" << p(90) << " p99=" << p(99) << " max=" << v.back() << "\n";
+        return os.str();
+    }
+
+    void encolar(Peticion p) {
+        Sesion& ses = sesion(p.nombre);
+        p.llegada = chrono::steady_clock::now();
+        {
+            lock_guard<mutex> lk(mCola);
+            ses.pendientes.push(move(p));
+            if (ses.atendida) return; // el hilo que la tiene la va a volver a encolar
+            ses.atendida = true;
+            listas.push(&ses);
+        }
+        cv.notify_one();
+    }
+    // Toma la próxima petición de una sesión lista; la sesión queda para este hilo.
+    // nullptr cuando el servidor se detiene.
+    Sesion* tomar(Peticion& p) {
+        unique_lock<mutex> lk(mCola);
+        cv.wait(lk, [&]{ return parar || !listas.empty(); });
+        if (parar) return nullptr;
+        Sesion* ses = listas.front();
+        listas.pop();
+        p = move(ses->pendientes.front());
+        ses->pendientes.pop();
+        return ses;
+    }
+    // Suelta la sesión; si le llegaron más peticiones vuelve al final de la cola
+    void soltar(Sesion& ses) {
+        {
+            lock_guard<mutex> lk(mCola);
+            if (ses.pendientes.empty()) { ses.atendida = false; return; }
+            listas.push(&ses);
+        }
+        cv.notify_one();
+    }
+
+    // Los hilos terminan la petición en curso y salen
+    void detener() {
+        { lock_guard<mutex> lk(mCola); parar = true; }
+        cv.notify_all();
+    }
+
+    // fd y si la respuesta se pudo mandar; cabe en un write atómico al pipe
+    void terminar(int fd, bool ok) {
+        int msg[2] = { fd, ok ? 1 : 0 };
+        ssize_t n = write(aviso[1], msg, sizeof(msg));
+        (void)n;
+    }
+};
+
+// -----------------------------
+// Trabajador: cada hilo reutiliza su scanner, parser, evaluador y buffers entre peticiones
+// -----------------------------
+
+class Trabajador {
+    Servidor& srv;
+    Scanner scanner{""};
+    Parser parser{&scanner};
+    EvalVisitor eval;
+    ostringstream salida;
+    string respuesta;
+
+    // Envía lo que se imprimió hasta ahora como líneas OUT
+    bool volcar(int fd) {
+        string s = salida.str();
+        if (s.empty()) return true;
+        salida.str("");
+        respuesta.clear();
+        size_t ini = 0, nl;
+        while ((nl = s.find('\n', ini)) != string::npos) {
+            respuesta.append("OUT ").append(s, ini, nl - ini).append("\n");
+            ini = nl + 1;
+        }
+        return enviar(fd, respuesta);
+    }
+
+    bool evaluar(const Peticion& p, Sesion& ses) {
+        int fd = p.fd;
+
+        // Las variables viven en el mapa de la sesión: el swap se lo presta al evaluador
+        // sin copiarlo, y ese mapa conserva sus buckets entre peticiones de la sesión.
+        // El mapa propio del evaluador solo está vacío mientras tanto.
+        eval.mem.swap(ses.mem);
+        string error;
+        bool ok = true;
+        try {
+            scanner.reiniciar(p.codigo);
+            parser.reiniciar();
+            unique_ptr<Program> prog(parser.parseProgram());
+            for (auto s : prog->slist) {
+                s->accept(&eval);
+                if (!(ok = volcar(fd))) break;
+            }
+        } catch (const exception& e) {
+            error = e.what();
+        }
+        eval.mem.swap(ses.mem);
+        if (!ok) return false;
+        salida.str("");
+
+        long us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - p.llegada).count();
+        srv.registrar(us);
+        if (!error.empty()) return enviar(fd, "ERR " + error + "\n");
+        return enviar(fd, "OK " + to_string(us) + "\n");
+    }
+
+public:
+    explicit Trabajador(Servidor& s): srv(s) { eval.out = &salida; }
+
+    void correr() {
+        while (true) {
+            Peticion p;
+            Sesion* sp = srv.tomar(p);
+            if (!sp) return;
+            Sesion& ses = *sp;
+            bool ok;
+            if (p.op == "EVAL") {
+                ok = evaluar(p, ses);
+            } else { // RESET
+                ses.mem.clear();
+                ok = enviar(p.fd, "OK\n");
+            }
+            srv.soltar(ses);
+            srv.terminar(p.fd, ok);
+        }
+    }
+};
+
+// -----------------------------
+// Hilo de E/S: poll sobre todas las conexiones, arma peticiones completas y las encola
+// -----------------------------
+
+static const int INACTIVIDAD_MS = 60000;         // conexiones ociosas se cierran
+static const size_t MAX_CODIGO = 64u << 20;      // tope de EVAL por petición
+
+struct Conexion {
+    string buf;
+    bool ocupada = false;   // hay una petición suya en un trabajador
+    bool cerrar = false;    // cerrar apenas termine esa petición
+    chrono::steady_clock::time_point ultima = chrono::steady_clock::now();
+};
+
+// Saca del buffer las peticiones listas mientras la conexión no tenga una en curso.
+// Devuelve false si hay que cerrar la conexión.
+static bool procesar(Servidor& srv, int fd, Conexion& c) {
+    while (!c.ocupada) {
+        size_t nl = c.buf.find('\n');
+        if (nl == string::npos) return c.buf.size() <= 4096; // una línea de comando no es tan larga
+        istringstream cmd(c.buf.substr(0, nl));
+        string op, nombre;
+        cmd >> op >> nombre;
+
+        if (op == "EVAL") {
+            size_t n = 0;
+            if (!(cmd >> n) || nombre.empty()) {
+                c.buf.erase(0, nl + 1);
+                if (!enviar(fd, "ERR peticion mal formada\n")) return false;
+                continue;
+            }
+            if (n > MAX_CODIGO) { enviar(fd, "ERR codigo demasiado grande\n"); return false; }
+            if (c.buf.size() - (nl + 1) < n) return true; // falta el cuerpo
+            Peticion p{fd, op, nombre, c.buf.substr(nl + 1, n)};
+            c.buf.erase(0, nl + 1 + n);
+            c.ocupada = true;
+            srv.encolar(move(p));
+        } else if (op == "RESET" && !nombre.empty()) {
+            c.buf.erase(0, nl + 1);
+            c.ocupada = true;
+            srv.encolar(Peticion{fd, op, nombre, ""});
+        } else if (op == "STATS") {
+            c.buf.erase(0, nl + 1);
+            if (!enviar(fd, srv.estadisticas())) return false;
+        } else if (op == "QUIT") {
+            return false;
+        } else {
+            c.buf.erase(0, nl + 1);
+            if (!enviar(fd, "ERR comando desconocido\n")) return false;
+        }
+    }
+    return true;
+}
+
+int ejecutar_servidor(const string& socket_path, int workers) {
+    int fd = conectar(socket_path, true);
+    if (fd < 0) {
+        cerr << "No se pudo escuchar en " << socket_path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    if (workers < 1) workers = 1;
+    cout << "Servidor escuchando en " << socket_path << " con " << workers << " hilos" << endl;
+
+    Servidor srv;
+    if (pipe(srv.aviso) < 0) {
+        cerr << "Error en pipe: " << strerror(errno) << endl;
+        return 1;
+    }
+    vector<thread> hilos;
+    for (int i = 0; i < workers; i++)
+        hilos.emplace_back([&srv]{ Trabajador(srv).correr(); });
+
+    unordered_map<int, Conexion> conexiones;
+    vector<pollfd> fds;
+    auto cerrar = [&](int c){ close(c); conexiones.erase(c); };
+
+    while (true) {
+        fds.clear();
+        fds.push_back({fd, POLLIN, 0});
+        fds.push_back({srv.aviso[0], POLLIN, 0});
+        // Una conexión que ya cerró su lado queda lista para siempre: no se vuelve a mirar
+        for (auto& kv : conexiones) if (!kv.second.cerrar) fds.push_back({kv.first, POLLIN, 0});
+
+        if (poll(fds.data(), fds.size(), 1000) < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Error en poll: " << strerror(errno) << endl;
+            break;
+        }
+        auto ahora = chrono::steady_clock::now();
+
+        // Peticiones terminadas: la conexión queda libre para la siguiente
+        if (fds[1].revents & POLLIN) {
+            int msg[2];
+            if (read(srv.aviso[0], msg, sizeof(msg)) == (ssize_t)sizeof(msg)) {
+                auto it = conexiones.find(msg[0]);
+                if (it != conexiones.end()) {
+                    it->second.ocupada = false;
+                    it->second.ultima = ahora;
+                    if (!msg[1] || it->second.cerrar || !procesar(srv, msg[0], it->second)) cerrar(msg[0]);
+                }
+            }
+        }
+
+        for (size_t i = 2; i < fds.size(); i++) {
+            if (!fds[i].revents) continue;
+            auto it = conexiones.find(fds[i].fd);
+            if (it == conexiones.end()) continue;
+            Conexion& c = it->second;
+            char tmp[65536];
+            ssize_t n = read(fds[i].fd, tmp, sizeof(tmp));
+            if (n <= 0) {
+                if (c.ocupada) c.cerrar = true; // el trabajador todavía usa el fd
+                else cerrar(fds[i].fd);
+                continue;
+            }
+            c.buf.append(tmp, n);
+            c.ultima = ahora;
+            if (c.buf.size() > MAX_CODIGO + 4096 || !procesar(srv, fds[i].fd, c)) {
+                if (c.ocupada) c.cerrar = true;
+                else cerrar(fds[i].fd);
+            }
+        }
+
+        // Conexiones ociosas
+        vector<int> viejas;
+        for (auto& kv : conexiones)
+            if (!kv.second.ocupada && ahora - kv.second.ultima > chrono::milliseconds(INACTIVIDAD_MS))
+                viejas.push_back(kv.first);
+        for (int c : viejas) cerrar(c);
+
+        if (fds[0].revents & POLLIN) {
+            int c = accept(fd, nullptr, nullptr);
+            if (c >= 0) {
+                // Un cliente que no lee sus respuestas no puede trabar a un trabajador para siempre
+                timeval tv{5, 0};
+                setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                conexiones[c];
+            }
+        }
+    }
+    // Los hilos usan srv y los fd: primero se los detiene, después se cierra todo
+    srv.detener();
+    for (auto& h : hilos) h.join();
+    for (auto& kv : conexiones) close(kv.first);
+    close(srv.aviso[0]);
+    close(srv.aviso[1]);
+    close(fd);
+    return 1;
+}
+
+// -----------------------------
+// Cliente de prueba
+// -----------------------------
+
+int ejecutar_cliente(const string& socket_path, const string& sesion, const string& archivo) {
+    int fd = conectar(socket_path, false);
+    if (fd < 0) {
+        cerr << "No se pudo conectar a " << socket_path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    Lector in(fd);
+    string linea;
+
+    if (sesion == "--stats") {
+        if (!enviar(fd, "STATS\n") || !in.linea(linea)) { close(fd); return 1; }
+        cout << linea << endl;
+        enviar(fd, "QUIT\n");
+        close(fd);
+        return 0;
+    }
+
+    string codigo;
+    if (archivo == "-") {
+        ostringstream ss; ss << cin.rdbuf(); codigo = ss.str();
+    } else {
+        ifstream infile(archivo);
+        if (!infile.is_open()) {
+            cerr << "No se pudo abrir el archivo: " << archivo << endl;
+            close(fd);
+            return 1;
+        }
+        ostringstream ss; ss << infile.rdbuf(); codigo = ss.str();
+    }
+
+    if (!enviar(fd, "EVAL " + sesion + " " + to_string(codigo.size()) + "\n" + codigo)) { close(fd); return 1; }
+    int rc = 1;
+    while (in.linea(linea)) {
+        if (linea.compare(0, 4, "OUT ") == 0) { cout << linea.substr(4) << endl; continue; }
+        if (linea.compare(0, 3, "OK ") == 0) { cerr << "(" << linea.substr(3) << " us)" << endl; rc = 0; }
+        else cerr << linea << endl;
+        break;
+    }
+    enviar(fd, "QUIT\n");
+    close(fd);
+    return rc;
+}
@@ -0,0 +1,34 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+using namespace std;
+
+// -----------------------------
+// Modo servidor sobre un socket Unix (AF_UNIX, sin red)
+// -----------------------------
+//
+// Protocolo de texto, varias peticiones por conexión:
+//
+//   EVAL <sesion> <n>\n<n bytes de código>   -> OUT <linea>* y luego OK <us> | ERR <msg>
+//   RESET <sesion>\n                         -> OK
+//   STATS\n                                  -> STATS n=.. p50=.. p90=.. p99=.. max=..
+//   QUIT\n                                   -> cierra la conexión
+//
+// Cada sesión guarda sus variables (el mem de EvalVisitor) entre peticiones.
+// Los OUT se envían al terminar cada sentencia, no al final del script.
+// Los <us> de OK y de STATS se miden desde que la petición llegó completa, con la
+// espera en cola incluida.
+// Un hilo de E/S hace poll sobre todas las conexiones y encola cada petición completa;
+// los hilos trabajadores atienden peticiones, no conexiones, y nunca dos de la misma
+// sesión a la vez. Las conexiones sin
+// actividad por 60s se cierran.
+
+// Escucha en socket_path y atiende con `workers` hilos. No retorna salvo error.
+int ejecutar_servidor(const string& socket_path, int workers);
+
+// Cliente de prueba: manda el archivo (o stdin si es "-") a la sesión indicada
+// e imprime la respuesta. Con sesion == "--stats" pide las latencias.
+int ejecutar_cliente(const string& socket_path, const string& sesion, const string& archivo);
+
+#endif // SERVER_H
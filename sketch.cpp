@@ -0,0 +1,104 @@
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "sketch.h"
+
+// splitmix64: mezcla suficiente para HLL y MinHash
+static uint64_t mezclar(uint64_t x){
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static void mismaPrecision(const Sketch& a, const Sketch& b){
+    if (a.derivado || b.derivado) throw std::runtime_error("Intersección/diferencia aproximada solo admite card()");
+    if (a.p != b.p || a.k != b.k) throw std::runtime_error("Conjuntos aproximados con distinto error");
+}
+
+Sketch Sketch::conError(double err){
+    err = std::min(0.5, std::max(0.005, err));
+    Sketch s;
+    // HLL: error ~ 1.04/sqrt(m); MinHash bottom-k: error ~ 1/sqrt(k)
+    s.p = std::min(18, std::max(4, (int)std::ceil(std::log2(std::pow(1.04 / err, 2)))));
+    s.k = (size_t)std::ceil(1.0 / (err * err));
+    s.reg.assign((size_t)1 << s.p, 0);
+    return s;
+}
+
+Sketch Sketch::desde(const std::set<int>& s, double err){
+    Sketch r = conError(err);
+    for (int x : s) r.agregar(x);
+    return r;
+}
+
+Sketch Sketch::vacioIgual() const {
+    if (derivado) throw std::runtime_error("Intersección/diferencia aproximada solo admite card()");
+    Sketch s;
+    s.p = p; s.k = k;
+    s.reg.assign(reg.size(), 0);
+    return s;
+}
+
+void Sketch::agregar(int x){
+    uint64_t h = mezclar((uint64_t)(uint32_t)x);
+    size_t idx = h >> (64 - p);
+    uint64_t w = h << p;
+    uint8_t rho = w == 0 ? 64 - p + 1 : __builtin_clzll(w) + 1;
+    if (rho > reg[idx]) reg[idx] = rho;
+
+    uint64_t m = mezclar(h);
+    if (minh.size() < k) minh.insert(m);
+    else if (m < *minh.rbegin() && minh.insert(m).second) minh.erase(std::prev(minh.end()));
+}
+
+double Sketch::cardinalidad() const {
+    if (derivado) return estimado;
+    if (minh.size() < k) return (double)minh.size(); // todavía cabe entero: es exacto
+    double m = (double)reg.size(), suma = 0;
+    int ceros = 0;
+    for (uint8_t r : reg) { suma += std::ldexp(1.0, -r); if (r == 0) ceros++; }
+    double alfa = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+    double e = alfa * m * m / suma;
+    if (e <= 2.5 * m && ceros > 0) e = m * std::log(m / ceros); // rango chico: conteo lineal
+    return e;
+}
+
+Sketch Sketch::unir(const Sketch& a, const Sketch& b){
+    mismaPrecision(a, b);
+    Sketch r = a;
+    for (size_t i = 0; i < r.reg.size(); i++) r.reg[i] = std::max(r.reg[i], b.reg[i]);
+    for (uint64_t m : b.minh) {
+        if (r.minh.size() < r.k) r.minh.insert(m);
+        else if (m < *r.minh.rbegin() && r.minh.insert(m).second) r.minh.erase(std::prev(r.minh.end()));
+    }
+    return r;
+}
+
+double Sketch::jaccard(const Sketch& a, const Sketch& b){
+    mismaPrecision(a, b);
+    // Los k menores de la unión son una muestra uniforme de A ∪ B
+    size_t vistos = 0, comunes = 0;
+    auto i = a.minh.begin(), j = b.minh.begin();
+    while (vistos < a.k && (i != a.minh.end() || j != b.minh.end())) {
+        if (j == b.minh.end() || (i != a.minh.end() && *i < *j)) ++i;
+        else if (i == a.minh.end() || *j < *i) ++j;
+        else { ++i; ++j; comunes++; }
+        vistos++;
+    }
+    return vistos == 0 ? 1.0 : (double)comunes / vistos; // dos vacíos son iguales, como en el exacto
+}
+
+Sketch Sketch::interseccion(const Sketch& a, const Sketch& b){
+    Sketch r;
+    r.derivado = true;
+    r.estimado = jaccard(a, b) * unir(a, b).cardinalidad();
+    return r;
+}
+
+Sketch Sketch::diferencia(const Sketch& a, const Sketch& b){
+    Sketch r;
+    r.derivado = true;
+    r.estimado = std::max(0.0, a.cardinalidad() - interseccion(a, b).estimado);
+    return r;
+}
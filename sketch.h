@@ -0,0 +1,34 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+#include <vector>
+#include <set>
+#include <cstdint>
+
+// Conjunto aproximado de tamaño fijo: HyperLogLog para la cardinalidad y
+// MinHash bottom-k (los k hashes más chicos) para la similitud de Jaccard.
+// La memoria depende solo del error pedido, no de cuántos elementos tenga.
+struct Sketch {
+    int p = 0;                      // HLL con 2^p registros
+    size_t k = 0;                   // tamaño del MinHash
+    std::vector<uint8_t> reg;
+    std::set<uint64_t> minh;
+
+    // Resultado de una intersección/diferencia: solo se conoce la estimación
+    bool derivado = false;
+    double estimado = 0;
+
+    // err: error relativo buscado (0.02 = 2%)
+    static Sketch conError(double err);
+    static Sketch desde(const std::set<int>& s, double err);
+    Sketch vacioIgual() const;      // mismo p y k, sin elementos
+
+    void agregar(int x);
+    double cardinalidad() const;
+
+    static Sketch unir(const Sketch& a, const Sketch& b);
+    static double jaccard(const Sketch& a, const Sketch& b);
+    static Sketch interseccion(const Sketch& a, const Sketch& b);
+    static Sketch diferencia(const Sketch& a, const Sketch& b);
+};
+
+#endif
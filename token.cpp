@@ -42,6 +42,9 @@ ostream& operator<<(ostream& outs, const Token& tok) {
         case Token::UNION:      outs << "TOKEN(UNION, \""  << tok.text << "\")"; break;
         case Token::INTERSECT:  outs << "TOKEN(INTERSECT, \""<< tok.text << "\")"; break;
         case Token::DIFF:       outs << "TOKEN(DIFF, \""   << tok.text << "\")"; break;
+        case Token::APPROX:     outs << "TOKEN(APPROX, \"" << tok.text << "\")"; break;
+        case Token::CARD:       outs << "TOKEN(CARD, \""   << tok.text << "\")"; break;
+        case Token::JACCARD:    outs << "TOKEN(JACCARD, \""<< tok.text << "\")"; break;
         case Token::ERR:    outs << "TOKEN(ERR, \""    << tok.text << "\")"; break;
         case Token::END:    outs << "TOKEN(END)"; break;
     }
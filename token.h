@@ -22,6 +22,8 @@ public:
         // conjuntos
         LBRACE, RBRACE, COMMA,   // { } ,
         UNION, INTERSECT, DIFF,  // cup cap \
+        // conjuntos aproximados
+        APPROX, CARD, JACCARD,
         // misceláneo
         ERR, END
     };
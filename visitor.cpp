@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cmath>
+#include <type_traits>
 #include "visitor.h"
 
 static int asInt(const Value& v){
@@ -11,15 +12,42 @@ static std::set<int> asSet(const Value& v){
     return v.s;
 }
 static void expectInt(const Value& v){ if (v.kind!=Value::INT) throw std::runtime_error("Elemento de set debe ser entero"); }
+static void expectConjunto(const Value& v){
+    if (v.kind != Value::SET && v.kind != Value::SKETCH) throw std::runtime_error("Se esperaba conjunto");
+}
+// Un SET exacto que se mezcla con uno aproximado se convierte con la misma precisión
+static Sketch comoSketch(const Value& v, const Sketch& molde){
+    if (v.kind == Value::SKETCH) return *v.k;
+    Sketch r = molde.vacioIgual();
+    for (int x : v.s) r.agregar(x);
+    return r;
+}
+// Literal (posiblemente entre paréntesis) o null
+static SetLiteralExp* comoLiteral(SetExp* s){
+    while (auto p = dynamic_cast<SetParenExp*>(s)) s = p->inner;
+    return dynamic_cast<SetLiteralExp*>(s);
+}
+// Los elementos del literal van directo al sketch, sin armar el std::set
+static Sketch sketchDeLiteral(Visitor* ev, SetLiteralExp* l, Sketch r){
+    for (auto ce : l->elems) {
+        Value v = ce->accept(ev);
+        expectInt(v);
+        r.agregar(v.i);
+    }
+    return r;
+}
 
 Value NumberExp::accept(Visitor* v){ return v->visit(this); }
 Value IdExp::accept(Visitor* v){ return v->visit(this); }
 Value BinaryExp::accept(Visitor* v){ return v->visit(this); }
 Value SqrtExp::accept(Visitor* v){ return v->visit(this); }
+Value CardExp::accept(Visitor* v){ return v->visit(this); }
+Value JaccardExp::accept(Visitor* v){ return v->visit(this); }
 Value SetIdExp::accept(Visitor* v){ return v->visit(this); }
 Value SetParenExp::accept(Visitor* v){ return v->visit(this); }
 Value SetBinaryExp::accept(Visitor* v){ return v->visit(this); }
 Value SetLiteralExp::accept(Visitor* v){ return v->visit(this); }
+Value ApproxExp::accept(Visitor* v){ return v->visit(this); }
 Value CExp::accept(Visitor* v){ return a? a->accept(v) : s->accept(v); }
 
 void AssignStm::accept(Visitor* v){ v->visit(this); }
@@ -53,11 +81,33 @@ Value EvalVisitor::visit(SqrtExp* e){
     return Value::fromInt((int)std::sqrt((double)v));
 }
 
+Value EvalVisitor::visit(CardExp* e){
+    Value v = e->inner->accept(this);
+    expectConjunto(v);
+    if (v.kind == Value::SET) return Value::fromInt((int)v.s.size());
+    return Value::fromInt((int)std::llround(v.k->cardinalidad()));
+}
+
+Value EvalVisitor::visit(JaccardExp* e){
+    Value A = e->left->accept(this);
+    Value B = e->right->accept(this);
+    expectConjunto(A); expectConjunto(B);
+    if (A.kind == Value::SET && B.kind == Value::SET) {
+        size_t comunes = 0;
+        for (int x: A.s) if (B.s.count(x)) comunes++;
+        size_t total = A.s.size() + B.s.size() - comunes;
+        if (total == 0) return Value::fromInt(100);
+        return Value::fromInt((int)std::lround(100.0 * comunes / total));
+    }
+    const Sketch& molde = A.kind == Value::SKETCH ? *A.k : *B.k;
+    return Value::fromInt((int)std::lround(100 * Sketch::jaccard(comoSketch(A, molde), comoSketch(B, molde))));
+}
+
 // ---- conjuntos
 Value EvalVisitor::visit(SetIdExp* e){
     auto it = mem.find(e->name);
     if (it==mem.end()) return Value::fromSet({});
-    if (it->second.kind != Value::SET) throw std::runtime_error("Id no es conjunto");
+    if (it->second.kind == Value::INT) throw std::runtime_error("Id no es conjunto");
     return it->second;
 }
 Value EvalVisitor::visit(SetParenExp* e){ return e->inner->accept(this); }
@@ -72,9 +122,38 @@ Value EvalVisitor::visit(SetLiteralExp* e){
     return Value::fromSet(std::move(acc));
 }
 
+Value EvalVisitor::visit(ApproxExp* e){
+    int err = e->err ? asInt(e->err->accept(this)) : 2;
+    if (err <= 0 || err >= 50) throw std::runtime_error("Error de approx debe estar entre 1 y 49 (%)");
+    if (SetLiteralExp* lit = comoLiteral(e->inner))
+        return Value::fromSketch(sketchDeLiteral(this, lit, Sketch::conError(err / 100.0)));
+    Value v = e->inner->accept(this);
+    expectConjunto(v);
+    if (v.kind == Value::SKETCH) return v; // ya es aproximado: se queda con su precisión
+    return Value::fromSketch(Sketch::desde(v.s, err / 100.0));
+}
+
 Value EvalVisitor::visit(SetBinaryExp* e){
-    std::set<int> A = asSet(e->left->accept(this));
-    std::set<int> B = asSet(e->right->accept(this));
+    // Un literal se evalúa al final: si el otro lado es aproximado, va directo al sketch
+    SetLiteralExp* litL = comoLiteral(e->left);
+    SetLiteralExp* litR = comoLiteral(e->right);
+    Value LV = litL ? Value::fromSet({}) : e->left->accept(this);
+    Value RV = litR ? Value::fromSet({}) : e->right->accept(this);
+    if (LV.kind == Value::SKETCH || RV.kind == Value::SKETCH) {
+        expectConjunto(LV); expectConjunto(RV);
+        const Sketch& molde = LV.kind == Value::SKETCH ? *LV.k : *RV.k;
+        Sketch L = litL ? sketchDeLiteral(this, litL, molde.vacioIgual()) : comoSketch(LV, molde);
+        Sketch R = litR ? sketchDeLiteral(this, litR, molde.vacioIgual()) : comoSketch(RV, molde);
+        switch (e->op){
+            case UNION_OP:     return Value::fromSketch(Sketch::unir(L, R));
+            case INTERSECT_OP: return Value::fromSketch(Sketch::interseccion(L, R));
+            case DIFF_OP:      return Value::fromSketch(Sketch::diferencia(L, R));
+        }
+    }
+    if (litL) LV = e->left->accept(this);
+    if (litR) RV = e->right->accept(this);
+    std::set<int> A = asSet(LV);
+    std::set<int> B = asSet(RV);
     std::set<int> R;
     switch (e->op){
         case UNION_OP:
@@ -93,16 +172,249 @@ void EvalVisitor::visit(AssignStm* s){
     mem[s->id] = v;
 }
 
-static void printValue(const Value& v){
-    if (v.kind==Value::INT) { std::cout << v.i << "\n"; }
+static void printValue(std::ostream& os, const Value& v){
+    if (v.kind==Value::INT) { os << v.i << "\n"; }
+    else if (v.kind==Value::SKETCH) { os << "~{" << std::llround(v.k->cardinalidad()) << "}\n"; }
     else {
-        std::cout << "{";
+        os << "{";
         bool first = true;
-        for (int x: v.s){ if(!first) std::cout<<","; std::cout<<x; first=false; }
-        std::cout << "}\n";
+        for (int x: v.s){ if(!first) os<<","; os<<x; first=false; }
+        os << "}\n";
     }
 }
 void EvalVisitor::visit(PrintStm* s){
     Value v = s->e->accept(this);
-    printValue(v);
+    printValue(*out, v);
+}
+
+// ---- programa
+void EvalVisitor::interprete(Program* p){
+    if (!p) return;
+    try {
+        for (auto s : p->slist) s->accept(this);
+    } catch (const std::exception& e) {
+        std::cerr << "Error en ejecución: " << e.what() << std::endl;
+    }
+}
+
+// ---- PrintVisitor (DOT / JSON)
+
+// Pila explícita para contar subárboles sin recursión (los ASTs pueden tener millones de nodos)
+struct Pendiente { Exp* e = nullptr; SetExp* s = nullptr; CExp* c = nullptr; Stm* st = nullptr; };
+static Pendiente pendiente(Exp* e){ Pendiente p; p.e = e; return p; }
+static Pendiente pendiente(SetExp* s){ Pendiente p; p.s = s; return p; }
+static Pendiente pendiente(CExp* c){ Pendiente p; p.c = c; return p; }
+static Pendiente pendiente(Stm* st){ Pendiente p; p.st = st; return p; }
+
+// Cuenta los nodos que PrintVisitor dibujaría (CExp y SetParenExp son transparentes)
+static long contarNodos(Pendiente ini){
+    long n = 0;
+    std::vector<Pendiente> pila{ini};
+    while (!pila.empty()) {
+        Pendiente p = pila.back(); pila.pop_back();
+        if (p.c) { pila.push_back(p.c->a ? pendiente(p.c->a) : pendiente(p.c->s)); continue; }
+        if (p.st) {
+            n++;
+            if (auto a = dynamic_cast<AssignStm*>(p.st)) pila.push_back(pendiente(a->rhs));
+            else if (auto q = dynamic_cast<PrintStm*>(p.st)) pila.push_back(pendiente(q->e));
+        } else if (p.e) {
+            n++;
+            if (auto b = dynamic_cast<BinaryExp*>(p.e)) { pila.push_back(pendiente(b->left)); pila.push_back(pendiente(b->right)); }
+            else if (auto q = dynamic_cast<SqrtExp*>(p.e)) pila.push_back(pendiente(q->inner));
+            else if (auto c = dynamic_cast<CardExp*>(p.e)) pila.push_back(pendiente(c->inner));
+            else if (auto j = dynamic_cast<JaccardExp*>(p.e)) { pila.push_back(pendiente(j->left)); pila.push_back(pendiente(j->right)); }
+        } else if (p.s) {
+            if (auto q = dynamic_cast<SetParenExp*>(p.s)) { pila.push_back(pendiente(q->inner)); continue; }
+            n++;
+            if (auto b = dynamic_cast<SetBinaryExp*>(p.s)) { pila.push_back(pendiente(b->left)); pila.push_back(pendiente(b->right)); }
+            else if (auto l = dynamic_cast<SetLiteralExp*>(p.s)) for (auto c : l->elems) pila.push_back(pendiente(c));
+            else if (auto a = dynamic_cast<ApproxExp*>(p.s)) { pila.push_back(pendiente(a->inner)); if (a->err) pila.push_back(pendiente(a->err)); }
+        }
+    }
+    return n;
+}
+
+static std::string tipoDe(Exp* e){
+    if (dynamic_cast<NumberExp*>(e)) return "NumberExp";
+    if (dynamic_cast<IdExp*>(e))     return "IdExp";
+    if (dynamic_cast<BinaryExp*>(e)) return "BinaryExp";
+    if (dynamic_cast<CardExp*>(e))    return "CardExp";
+    if (dynamic_cast<JaccardExp*>(e)) return "JaccardExp";
+    return "SqrtExp";
+}
+static std::string tipoDe(SetExp* s){
+    if (dynamic_cast<SetIdExp*>(s))     return "SetIdExp";
+    if (dynamic_cast<SetParenExp*>(s))  return "SetParenExp";
+    if (dynamic_cast<SetBinaryExp*>(s)) return "SetBinaryExp";
+    if (dynamic_cast<ApproxExp*>(s))    return "ApproxExp";
+    return "SetLiteralExp";
+}
+static std::string tipoDe(Stm* s){ return dynamic_cast<AssignStm*>(s) ? "AssignStm" : "PrintStm"; }
+
+// 950 -> "950", 12345 -> "12k", 3400000 -> "3M"
+static std::string abreviar(long n){
+    if (n < 1000) return std::to_string(n);
+    if (n < 1000000) return std::to_string(n / 1000) + "k";
+    return std::to_string(n / 1000000) + "M";
+}
+
+static void escapar(std::string& out, const std::string& s){
+    for (char c : s) { if (c=='"' || c=='\\') out += '\\'; out += c; }
+}
+
+void PrintVisitor::volcar(){
+    if (f && !buf.empty()) std::fwrite(buf.data(), 1, buf.size(), f);
+    buf.clear();
+}
+
+// Emite un nodo con los hijos hijos[base..] y los saca de la pila
+int PrintVisitor::cerrar(const std::string& etiqueta, size_t base, bool compartible){
+    if (compartir && compartible) {
+        clave = etiqueta;
+        for (size_t i = base; i < hijos.size(); i++) { clave += ','; clave += std::to_string(hijos[i]); }
+        auto it = vistos.find(clave);
+        if (it != vistos.end()) { hijos.resize(base); return it->second; }
+    }
+    int id = siguiente++;
+    if (json) {
+        if (id > 0) buf += ',';
+        buf += "[\"";
+        escapar(buf, etiqueta);
+        buf += "\",[";
+        for (size_t i = base; i < hijos.size(); i++) {
+            if (i > base) buf += ',';
+            buf += std::to_string(hijos[i]);
+        }
+        buf += "]]";
+    } else {
+        std::string nodo = "node" + std::to_string(id);
+        buf += "  " + nodo + " [label=\"";
+        escapar(buf, etiqueta);
+        buf += "\"];\n";
+        for (size_t i = base; i < hijos.size(); i++)
+            buf += "  " + nodo + " -> node" + std::to_string(hijos[i]) + ";\n";
+    }
+    if (compartir && compartible) vistos.emplace(clave, id);
+    hijos.resize(base);
+    if (buf.size() >= (1 << 16)) volcar();
+    return id;
+}
+
+template<class T> int PrintVisitor::resumen(T* n){
+    long total = contarNodos(pendiente(n));
+    return cerrar(tipoDe(n) + " ×" + abreviar(total), hijos.size(), false);
+}
+
+template<class T> int PrintVisitor::hijo(T* n){
+    if constexpr (std::is_same<T, CExp>::value) {
+        return n->a ? hijo(n->a) : hijo(n->s);
+    } else {
+        if (profundidad >= maxProfundidad || siguiente >= maxNodos) return resumen(n);
+        profundidad++;
+        int id;
+        if constexpr (std::is_base_of<Stm, T>::value) { n->accept(this); id = ultimo; }
+        else id = n->accept(this).i;
+        profundidad--;
+        return id;
+    }
+}
+
+// Empuja los ids de v[0..n). En cuanto un hermano ya no entra (profundidad o presupuesto),
+// él y todos los que siguen se resumen en un único nodo "<grupo> ×N"
+template<class T> void PrintVisitor::hermanos(T* const* v, size_t n, const char* grupo){
+    for (size_t i = 0; i < n; i++) {
+        if (n - i > 1 && (profundidad >= maxProfundidad || siguiente >= maxNodos)) {
+            long total = 0;
+            for (size_t j = i; j < n; j++) total += contarNodos(pendiente(v[j]));
+            int id = cerrar(std::string(grupo) + " ×" + abreviar(total), hijos.size(), false);
+            hijos.push_back(id);
+            return;
+        }
+        int id = hijo(v[i]);
+        hijos.push_back(id);
+    }
+}
+
+Value PrintVisitor::visit(NumberExp* e){ return Value::fromInt(cerrar(std::to_string(e->value), hijos.size())); }
+Value PrintVisitor::visit(IdExp* e){ return Value::fromInt(cerrar(e->name, hijos.size())); }
+
+Value PrintVisitor::visit(BinaryExp* e){
+    static const char* ops[] = { "+", "-", "*", "/", "**" };
+    size_t base = hijos.size();
+    Exp* hs[] = { e->left, e->right };
+    hermanos(hs, 2, "Exp");
+    return Value::fromInt(cerrar(ops[e->op], base));
+}
+
+Value PrintVisitor::visit(SqrtExp* e){
+    size_t base = hijos.size();
+    int c = hijo(e->inner); hijos.push_back(c);
+    return Value::fromInt(cerrar("sqrt", base));
+}
+
+Value PrintVisitor::visit(CardExp* e){
+    size_t base = hijos.size();
+    int c = hijo(e->inner); hijos.push_back(c);
+    return Value::fromInt(cerrar("card", base));
+}
+
+Value PrintVisitor::visit(JaccardExp* e){
+    size_t base = hijos.size();
+    SetExp* hs[] = { e->left, e->right };
+    hermanos(hs, 2, "SetExp");
+    return Value::fromInt(cerrar("jaccard", base));
+}
+
+Value PrintVisitor::visit(SetIdExp* e){ return Value::fromInt(cerrar(e->name, hijos.size())); }
+Value PrintVisitor::visit(SetParenExp* e){ return e->inner->accept(this); }
+
+Value PrintVisitor::visit(SetBinaryExp* e){
+    static const char* ops[] = { "cup", "cap", "\\" };
+    size_t base = hijos.size();
+    SetExp* hs[] = { e->left, e->right };
+    hermanos(hs, 2, "SetExp");
+    return Value::fromInt(cerrar(ops[e->op], base));
+}
+
+Value PrintVisitor::visit(SetLiteralExp* e){
+    size_t base = hijos.size();
+    hermanos(e->elems.data(), e->elems.size(), "CExp");
+    return Value::fromInt(cerrar("{ }", base));
+}
+
+Value PrintVisitor::visit(ApproxExp* e){
+    size_t base = hijos.size();
+    int c = hijo(e->inner); hijos.push_back(c);
+    if (e->err) { int r = hijo(e->err); hijos.push_back(r); }
+    return Value::fromInt(cerrar("approx", base));
+}
+
+void PrintVisitor::visit(AssignStm* s){
+    size_t base = hijos.size();
+    int c = hijo(s->rhs); hijos.push_back(c);
+    ultimo = cerrar(s->id + " =", base);
+}
+
+void PrintVisitor::visit(PrintStm* s){
+    size_t base = hijos.size();
+    int c = hijo(s->e); hijos.push_back(c);
+    ultimo = cerrar("print", base);
+}
+
+void PrintVisitor::imprimir(Program* p){
+    if (!p) return;
+    std::string destino = !ruta.empty() ? ruta : json ? "ast.json" : "ast.dot";
+    f = std::fopen(destino.c_str(), "w");
+    if (!f) { std::cerr << "No se pudo abrir " << destino << std::endl; return; }
+    siguiente = 0; profundidad = 0; ultimo = -1;
+    hijos.clear(); vistos.clear(); buf.clear();
+
+    buf += json ? "{\"nodes\":[" : "digraph AST {\n";
+    hermanos(p->slist.data(), p->slist.size(), "Stm");
+    int raiz = cerrar("Program", 0);
+    if (json) buf += "],\"root\":" + std::to_string(raiz) + "}\n";
+    else buf += "}\n";
+    volcar();
+    std::fclose(f);
+    f = nullptr;
 }
@@ -2,22 +2,76 @@
 #define VISITOR_H
 #include "ast.h"
 #include <unordered_map>
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 struct EvalVisitor : Visitor {
     std::unordered_map<std::string, Value> mem;
+    std::ostream* out = &std::cout; // destino de print (el servidor lo redirige)
+
+    // Ejecuta todas las sentencias del programa sobre mem
+    void interprete(Program* p);
 
     Value visit(NumberExp*) override;
     Value visit(IdExp*) override;
     Value visit(BinaryExp*) override;
     Value visit(SqrtExp*) override;
+    Value visit(CardExp*) override;
+    Value visit(JaccardExp*) override;
 
     Value visit(SetIdExp*) override;
     Value visit(SetParenExp*) override;
     Value visit(SetBinaryExp*) override;
     Value visit(SetLiteralExp*) override;
+    Value visit(ApproxExp*) override;
 
     void visit(AssignStm*) override;
     void visit(PrintStm*) override;
 };
 
+// Escribe el AST en DOT (o JSON compacto) mientras lo recorre, sin armar el grafo en memoria.
+// Pasado maxProfundidad o maxNodos, cada subárbol se resume en un nodo "BinaryExp ×12k".
+// Los visit de expresiones devuelven el id del nodo emitido como Value INT.
+struct PrintVisitor : Visitor {
+    std::string ruta;       // vacía: ast.dot, o ast.json con json
+    int maxProfundidad = 200;
+    int maxNodos = 10000;
+    bool compartir = false; // subárboles idénticos se dibujan una sola vez
+    bool json = false;      // {"nodes":[[etiqueta,[hijos]],...],"root":id}
+
+    void imprimir(Program* p);
+
+    Value visit(NumberExp*) override;
+    Value visit(IdExp*) override;
+    Value visit(BinaryExp*) override;
+    Value visit(SqrtExp*) override;
+    Value visit(CardExp*) override;
+    Value visit(JaccardExp*) override;
+
+    Value visit(SetIdExp*) override;
+    Value visit(SetParenExp*) override;
+    Value visit(SetBinaryExp*) override;
+    Value visit(SetLiteralExp*) override;
+    Value visit(ApproxExp*) override;
+
+    void visit(AssignStm*) override;
+    void visit(PrintStm*) override;
+
+private:
+    std::FILE* f = nullptr;
+    std::string buf;                    // se vuelca al archivo cada 64KB
+    std::vector<int> hijos;             // ids de hijos pendientes, por nivel
+    std::unordered_map<std::string, int> vistos; // etiqueta+hijos -> id (solo si compartir)
+    std::string clave;
+    int siguiente = 0, profundidad = 0, ultimo = -1;
+
+    template<class T> int hijo(T* n);
+    template<class T> int resumen(T* n);
+    template<class T> void hermanos(T* const* v, size_t n, const char* grupo);
+    int cerrar(const std::string& etiqueta, size_t base, bool compartible = true);
+    void volcar();
+};
+
 #endif